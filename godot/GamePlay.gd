@@ -6,7 +6,6 @@ var chess = preload("res://bin/chess.gdns").new()
 var dragging = false
 var dragged
 var start_pos
-var capturing := false
 
 export (AudioStream) var checkmate_sound
 export (AudioStream) var check_sound
@@ -30,17 +29,25 @@ const frames = {
 	"empty": -1
 }
 
+# bits of chess.status()
+const WHITE_TURN = 1
+const IN_CHECK = 2
+const CHECKMATE = 4
+const STALEMATE = 8
+const CAPTURED = 16
+
 
 func _init():
-	_setup_pieces()
+	_setup_pieces(chess.status())
 
 
-func _setup_pieces():
+func _setup_pieces(status: int):
 	for i in get_children():
 		if not i is AudioStreamPlayer:
 			i.queue_free()
 		
 	var state = chess.board_state()
+	var white_turn = status & WHITE_TURN
 	for i in range (0,64):
 		if frames[state[i]] == -1:
 			continue
@@ -54,10 +61,10 @@ func _setup_pieces():
 		piece.rect_size = Vector2(75, 75)
 		piece.connect("grabbed", self, "_on_Button_grabbed")
 		if state[i].begins_with("black"):
-			if chess.is_white_turn():
+			if white_turn:
 				piece.disabled = true
 		else:
-			if not chess.is_white_turn():
+			if not white_turn:
 				piece.disabled = true
 		add_child(piece)
 
@@ -74,7 +81,6 @@ func _input(event):
 		dragging = false
 		dragged.get_node("Sprite").z_index = 0
 		var new_grid_pos = _grid_pos(dragged.get_position())
-		capturing = chess.board_state()[new_grid_pos.x*8+new_grid_pos.y] != "empty"
 		if chess.move(dragged.grid_pos, new_grid_pos):
 			_on_move()
 		else:
@@ -82,28 +88,29 @@ func _input(event):
 
 
 func _on_move():
-	_setup_pieces()
-	if chess.is_stalemated():
+	var status = chess.status()
+	_setup_pieces(status)
+	if status & STALEMATE:
 		emit_signal("status_change", "Stalemate")
-	elif chess.is_checkmated():
-		var new_status = "Black wins!" if chess.is_white_turn() else "White wins!"
+	elif status & CHECKMATE:
+		var new_status = "Black wins!" if status & WHITE_TURN else "White wins!"
 		emit_signal("status_change", new_status)
 	else:
-		var new_status = "White" if chess.is_white_turn() else "Black"
-		new_status += " in Check!" if chess.is_in_check() else " Move"
+		var new_status = "White" if status & WHITE_TURN else "Black"
+		new_status += " in Check!" if status & IN_CHECK else " Move"
 		emit_signal("status_change", new_status)
-	_play_sound_effect()
+	_play_sound_effect(status)
 
 
-func _play_sound_effect():
+func _play_sound_effect(status: int):
 	var sound: AudioStream
-	if chess.is_checkmated():
+	if status & CHECKMATE:
 		sound = checkmate_sound
-	elif chess.is_in_check():
+	elif status & IN_CHECK:
 		sound = check_sound
-	elif capturing:
+	elif status & CAPTURED:
 		sound = capture_sound
-	elif chess.is_white_turn(): # black just went
+	elif status & WHITE_TURN: # black just went
 		sound = black_move_sound
 	else:
 		sound = white_move_sound
@@ -1,4 +1,6 @@
 #include "Chess.hpp"
+#include <stdexcept>
+#include <string>
 
 
 Chess::Chess() : boardState_{} {
@@ -27,18 +29,145 @@ Chess::Chess() : boardState_{} {
     calculateLegalMoves( inserter, whiteTurn );
 }
 
+Chess::Chess( std::string_view fen ) : boardState_{} {
+    const auto malformed = [ & ] { return std::invalid_argument( "Malformed FEN: " + std::string{ fen } ); };
+
+    // piece placement, starting from the eighth rank which is row 0
+    std::size_t position = 0;
+    bool        whiteKingFound = false;
+    bool        blackKingFound = false;
+    for ( int row = 0, column = 0; row < 8; ++position ) {
+        if ( position == fen.size()) throw malformed();
+        char c = fen[ position ];
+        if ( c == '/' ) {
+            if ( column != 8 ) throw malformed();
+            ++row;
+            column = 0;
+            continue;
+        }
+        if ( c == ' ' ) {
+            if ( row != 7 || column != 8 ) throw malformed();
+            break;
+        }
+        if ( c >= '1' && c <= '8' ) {
+            column += c - '0';
+            if ( column > 8 ) throw malformed();
+            continue;
+        }
+        if ( column == 8 ) throw malformed();
+
+        Cell cell{ c >= 'a' ? State::BLACK : State::WHITE, Pieces::PAWN };
+        switch ( c >= 'a' ? c - 'a' + 'A' : c ) {
+            case 'P':cell.piece = Pieces::PAWN;
+                // pawns never stand on the first or last rank, and move generation relies on it
+                if ( row == 0 || row == 7 ) throw malformed();
+                break;
+            case 'R':cell.piece = Pieces::ROOK;
+                break;
+            case 'N':cell.piece = Pieces::KNIGHT;
+                break;
+            case 'B':cell.piece = Pieces::BISHOP;
+                break;
+            case 'Q':cell.piece = Pieces::QUEEN;
+                break;
+            case 'K':cell.piece = Pieces::KING;
+                if ( cell.state == State::WHITE ) {
+                    whiteKingLocation = { row, column };
+                    whiteKingFound    = true;
+                }
+                else {
+                    blackKingLocation = { row, column };
+                    blackKingFound    = true;
+                }
+                break;
+            default:throw malformed();
+        }
+        boardState_[ row ][ column++ ] = cell;
+    }
+    if ( !whiteKingFound || !blackKingFound ) throw malformed();
+
+    // side to move
+    while ( position < fen.size() && fen[ position ] == ' ' ) ++position;
+    if ( position == fen.size()) throw malformed();
+    if ( fen[ position ] == 'w' ) whiteTurn = true;
+    else if ( fen[ position ] == 'b' ) whiteTurn = false;
+    else throw malformed();
+    ++position;
+
+    // castling rights, all of them if the field is missing
+    while ( position < fen.size() && fen[ position ] == ' ' ) ++position;
+    std::string_view castling = "KQkq";
+    if ( position < fen.size()) castling = fen.substr( position, fen.find( ' ', position ) - position );
+    if ( castling != "-" && castling.find_first_not_of( "KQkq" ) != std::string_view::npos ) throw malformed();
+    whiteKingsRookMoved  = castling.find( 'K' ) == std::string_view::npos;
+    whiteQueensRookMoved = castling.find( 'Q' ) == std::string_view::npos;
+    blackKingsRookMoved  = castling.find( 'k' ) == std::string_view::npos;
+    blackQueensRookMoved = castling.find( 'q' ) == std::string_view::npos;
+    whiteKingMoved       = whiteKingsRookMoved && whiteQueensRookMoved;
+    blackKingMoved       = blackKingsRookMoved && blackQueensRookMoved;
+
+    // castling moves are generated without looking at where the king and rook are, so they must be at home
+    const auto atHome = [ & ]( bool moved, std::pair<int, int> location, State state, Pieces piece ) {
+        const auto& cell = atLocation( location );
+        return moved || ( cell.state == state && cell.piece == piece );
+    };
+    if ( !atHome( whiteKingMoved, { 7, 4 }, State::WHITE, Pieces::KING ) ||
+         !atHome( whiteKingsRookMoved, { 7, 7 }, State::WHITE, Pieces::ROOK ) ||
+         !atHome( whiteQueensRookMoved, { 7, 0 }, State::WHITE, Pieces::ROOK ) ||
+         !atHome( blackKingMoved, { 0, 4 }, State::BLACK, Pieces::KING ) ||
+         !atHome( blackKingsRookMoved, { 0, 7 }, State::BLACK, Pieces::ROOK ) ||
+         !atHome( blackQueensRookMoved, { 0, 0 }, State::BLACK, Pieces::ROOK ))
+        throw malformed();
+
+    // determine if the player to move is in check
+    {
+        MovesDatabase otherPlayersMoves{};
+        auto          inserter = otherPlayersMoves.inserter();
+        calculateLegalMoves( inserter, !whiteTurn );
+        auto kingLocation = whiteTurn ? whiteKingLocation : blackKingLocation;
+        otherPlayersMoves.db << "SELECT EXISTS(SELECT * FROM moves WHERE end_x = ? AND end_y = ?);"
+                             << kingLocation.first << kingLocation.second
+                             >> inCheck;
+    }
+
+    auto inserter = moves.inserter();
+    calculateLegalMoves( inserter, whiteTurn );
+
+    // try out each move to see if the game is already over
+    bool legalMoveExists = false;
+    for ( const auto& move: legalMoves()) {
+        Undo undo;
+        if ( this->move( move.start, move.end, false, &undo )) {
+            this->undo( move, undo );
+            legalMoveExists = true;
+            break;
+        }
+    }
+    if ( !legalMoveExists ) {
+        if ( inCheck ) inCheckmate = true;
+        else inStalemate = true;
+    }
+}
+
 Chess::Chess( const Chess& other ) :
         boardState_{ other.boardState_ },
+        whiteKingLocation{ other.whiteKingLocation },
+        blackKingLocation{ other.blackKingLocation },
         whiteTurn{ other.whiteTurn },
         inCheck{ other.inCheck },
         inCheckmate{ other.inCheckmate },
-        whiteKingLocation{ other.whiteKingLocation },
-        blackKingLocation{ other.blackKingLocation } {
+        inStalemate{ other.inStalemate },
+        whiteKingMoved{ other.whiteKingMoved },
+        whiteKingsRookMoved{ other.whiteKingsRookMoved },
+        whiteQueensRookMoved{ other.whiteQueensRookMoved },
+        blackKingMoved{ other.blackKingMoved },
+        blackKingsRookMoved{ other.blackKingsRookMoved },
+        blackQueensRookMoved{ other.blackQueensRookMoved } {
     auto inserter = moves.inserter();
     calculateLegalMoves( inserter, whiteTurn );
 }
 
-bool Chess::move( std::pair<int, int> start, std::pair<int, int> end, bool extendedChecks ) {
+bool Chess::move( std::pair<int, int> start, std::pair<int, int> end, bool extendedChecks, Undo* undo ) {
     if ( inCheckmate ) return false;
     if ( inStalemate ) return false;
 
@@ -57,6 +186,15 @@ bool Chess::move( std::pair<int, int> start, std::pair<int, int> end, bool exten
         if ( !moveFound ) return false;
     }
 
+    // record what is needed to take the move back
+    if ( undo ) {
+        const auto& captured = atLocation( end );
+        undo->captured = static_cast<std::uint8_t>(( static_cast<int>(captured.state) << 3 ) |
+                                                   static_cast<int>(captured.piece));
+        undo->moved    = static_cast<std::uint8_t>(atLocation( start ).piece);
+        undo->flags    = packFlags();
+    }
+
     // make the move
     auto& startCell = atLocation( start );
     auto& endCell   = atLocation( end );
@@ -172,9 +310,9 @@ bool Chess::move( std::pair<int, int> start, std::pair<int, int> end, bool exten
         if ( !pieceExists ) inStalemate = true;
     }
 
-    // update tracking data for castling
+    // update tracking data for castling, the turn has already passed to the other player
     if ( endCell.piece == Pieces::KING ) {
-        if ( whiteTurn )
+        if ( !whiteTurn )
             whiteKingMoved = true;
         else
             blackKingMoved = true;
@@ -222,6 +360,13 @@ void Chess::calculateLegalMoves( MovesDatabase::Inserter& inserter, bool isWhite
     }
 }
 
+namespace {
+    bool validateLocation( std::pair<int, int> location ) {
+        return location.first >= 0 && location.first < 8 &&
+               location.second >= 0 && location.second < 8;
+    }
+}
+
 void Chess::calculatePawnMoves( MovesDatabase::Inserter& inserter, std::pair<int, int> location, bool isWhite ) {
     if ( isWhite ) {
         std::pair<int, int> oneForward = { location.first - 1, location.second };
@@ -238,13 +383,13 @@ void Chess::calculatePawnMoves( MovesDatabase::Inserter& inserter, std::pair<int
         // check if it can capture
         {
             std::pair<int, int> diagonal = { location.first - 1, location.second - 1 };
-            if ( atLocation( diagonal ).state == State::BLACK )
+            if ( validateLocation( diagonal ) && atLocation( diagonal ).state == State::BLACK )
                 inserter.insert( { location, diagonal } );
         }
         // check other diagonal
         {
             std::pair<int, int> diagonal = { location.first - 1, location.second + 1 };
-            if ( atLocation( diagonal ).state == State::BLACK )
+            if ( validateLocation( diagonal ) && atLocation( diagonal ).state == State::BLACK )
                 inserter.insert( { location, diagonal } );
         }
     }
@@ -263,25 +408,18 @@ void Chess::calculatePawnMoves( MovesDatabase::Inserter& inserter, std::pair<int
         // check if it can capture
         {
             std::pair<int, int> diagonal = { location.first + 1, location.second - 1 };
-            if ( atLocation( diagonal ).state == State::WHITE )
+            if ( validateLocation( diagonal ) && atLocation( diagonal ).state == State::WHITE )
                 inserter.insert( { location, diagonal } );
         }
         // check other diagonal
         {
             std::pair<int, int> diagonal = { location.first + 1, location.second + 1 };
-            if ( atLocation( diagonal ).state == State::WHITE )
+            if ( validateLocation( diagonal ) && atLocation( diagonal ).state == State::WHITE )
                 inserter.insert( { location, diagonal } );
         }
     }
 }
 
-namespace {
-    bool validateLocation( std::pair<int, int> location ) {
-        return location.first >= 0 && location.first < 8 &&
-               location.second >= 0 && location.second < 8;
-    }
-}
-
 void Chess::checkInDirection( MovesDatabase::Inserter& inserter,
                               std::pair<int, int> location,
                               bool isWhite,
@@ -470,17 +608,116 @@ void Chess::calculateKingMoves( MovesDatabase::Inserter& inserter, std::pair<int
                                  >> castlingThroughCheck;
             if ( !castlingThroughCheck )
                 inserter.insert( {{ 0, 4 },
-                                  { 0, 6 }} );
-            inserter.insert( {{ 0, 4 },
-                              { 0, 2 }} );
+                                  { 0, 2 }} );
         }
     }
 }
 
+void Chess::undo( const Move& move, const Undo& undo ) {
+    auto& startCell = atLocation( move.start );
+    auto& endCell   = atLocation( move.end );
+    startCell = { endCell.state, static_cast<Pieces>(undo.moved) };
+    endCell   = { static_cast<State>(undo.captured >> 3), static_cast<Pieces>(undo.captured & 0x7) };
+
+    if ( startCell.piece == Pieces::KING ) {
+        if ( startCell.state == State::WHITE )
+            whiteKingLocation = move.start;
+        else
+            blackKingLocation = move.start;
+
+        // if castling put the rook back
+        int row = move.start.first;
+        if ( move.start.second == 4 && move.end.second == 2 ) {
+            atLocation( { row, 0 } ) = atLocation( { row, 3 } );
+            atLocation( { row, 3 } ).state = State::EMPTY;
+        }
+        else if ( move.start.second == 4 && move.end.second == 6 ) {
+            atLocation( { row, 7 } ) = atLocation( { row, 5 } );
+            atLocation( { row, 5 } ).state = State::EMPTY;
+        }
+    }
+
+    unpackFlags( undo.flags );
+
+    moves.db << "DELETE FROM moves";
+    auto inserter = moves.inserter();
+    calculateLegalMoves( inserter, whiteTurn );
+}
+
+namespace {
+    constexpr std::uint64_t splitMix( std::uint64_t& state ) {
+        std::uint64_t z = ( state += 0x9e3779b97f4a7c15 );
+        z = ( z ^ ( z >> 30 )) * 0xbf58476d1ce4e5b9;
+        z = ( z ^ ( z >> 27 )) * 0x94d049bb133111eb;
+        return z ^ ( z >> 31 );
+    }
+
+    // one key per color, piece and square, followed by one per bit of the packed flags
+    constexpr auto zobristKeys = [] {
+        std::array<std::uint64_t, 2 * 6 * 64 + 16> keys{};
+        std::uint64_t state = 0;
+        for ( auto& key: keys )
+            key = splitMix( state );
+        return keys;
+    }();
+}
+
+std::uint64_t Chess::hash() const {
+    std::uint64_t result = 0;
+    for ( int i = 0; i < 8; ++i ) {
+        for ( int j = 0; j < 8; ++j ) {
+            const auto& cell = boardState_[ i ][ j ];
+            if ( cell.state == State::EMPTY ) continue;
+            int color = cell.state == State::WHITE ? 0 : 1;
+            result ^= zobristKeys[ ( color * 6 + static_cast<int>(cell.piece)) * 64 + i * 8 + j ];
+        }
+    }
+
+    // only the turn and castling flags, the others follow from the position
+    auto flags = packFlags();
+    for ( int bit = 0; bit < 10; ++bit ) {
+        if ( bit >= 1 && bit <= 3 ) continue;
+        if ( flags & 1 << bit ) result ^= zobristKeys[ 2 * 6 * 64 + bit ];
+    }
+    return result;
+}
+
+std::uint16_t Chess::packFlags() const {
+    return static_cast<std::uint16_t>(
+            whiteTurn << 0 | inCheck << 1 | inCheckmate << 2 | inStalemate << 3 |
+            whiteKingMoved << 4 | whiteKingsRookMoved << 5 | whiteQueensRookMoved << 6 |
+            blackKingMoved << 7 | blackKingsRookMoved << 8 | blackQueensRookMoved << 9 );
+}
+
+void Chess::unpackFlags( std::uint16_t flags ) {
+    whiteTurn            = flags & 1 << 0;
+    inCheck              = flags & 1 << 1;
+    inCheckmate          = flags & 1 << 2;
+    inStalemate          = flags & 1 << 3;
+    whiteKingMoved       = flags & 1 << 4;
+    whiteKingsRookMoved  = flags & 1 << 5;
+    whiteQueensRookMoved = flags & 1 << 6;
+    blackKingMoved       = flags & 1 << 7;
+    blackKingsRookMoved  = flags & 1 << 8;
+    blackQueensRookMoved = flags & 1 << 9;
+}
+
 bool operator==( const Chess::Move& a, const Chess::Move& b ) {
     return a.start == b.start && a.end == b.end;
 }
 
+std::uint16_t Chess::packMove( const Move& move ) {
+    return static_cast<std::uint16_t>(( move.start.first * 8 + move.start.second ) << 6 |
+                                      ( move.end.first * 8 + move.end.second ));
+}
+
+Chess::Move Chess::unpackMove( std::uint16_t move ) {
+    int start = move >> 6;
+    int end   = move & 0x3f;
+    return {{ start / 8, start % 8 },
+            { end / 8,   end % 8 }};
+}
+
 Chess::Cell& Chess::atLocation( std::pair<int, int> location ) {
     return boardState_[ location.first ][ location.second ];
 }
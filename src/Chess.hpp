@@ -1,6 +1,8 @@
 #pragma once
 
 #include <array>
+#include <cstdint>
+#include <string_view>
 #include <utility>
 #include <unordered_set>
 #include <sqlite_modern_cpp.h>
@@ -24,11 +26,27 @@ public:
 
     Chess();
 
+    /**
+     * Sets up the position described by a FEN record. The en passant square and move counters are ignored
+     * @throws std::invalid_argument if the record is malformed
+     */
+    explicit Chess( std::string_view fen );
+
     Chess( const Chess& other );
 
     [[nodiscard]] const BoardState& boardState() const { return boardState_; }
 
-    bool move( std::pair<int, int> start, std::pair<int, int> end, bool extendedChecks );
+    /**
+     * Everything move() overwrites that can't be derived from the move itself. Packed so a history of moves stays
+     * small; see undo()
+     */
+    struct Undo {
+        std::uint8_t  captured; // state << 3 | piece of the destination square before the move
+        std::uint8_t  moved;    // piece that moved, before any promotion
+        std::uint16_t flags;    // turn, check, mate, stalemate and castling flags before the move
+    };
+
+    bool move( std::pair<int, int> start, std::pair<int, int> end, bool extendedChecks, Undo* undo = nullptr );
 
     [[nodiscard]] bool isWhiteTurn() const { return whiteTurn; }
 
@@ -38,6 +56,11 @@ public:
 
     [[nodiscard]] bool isStalemated() const { return inStalemate; }
 
+    /**
+     * Zobrist hash of the pieces, the side to move and the castling rights
+     */
+    [[nodiscard]] std::uint64_t hash() const;
+
     struct Move {
         std::pair<int, int> start;
         std::pair<int, int> end;
@@ -47,13 +70,31 @@ public:
 
     friend bool operator!=( const Move& a, const Move& b ) { return !( a == b ); }
 
+    /**
+     * Packs a move into 12 bits, 6 for each square, numbering squares row * 8 + column
+     */
+    static std::uint16_t packMove( const Move& move );
+
+    static Move unpackMove( std::uint16_t move );
+
     using LegalMoves = std::vector<Move>;
 
     [[nodiscard]] LegalMoves legalMoves() const;
 
+    /**
+     * Reverts a move previously made with move(). Must be called in reverse order of the moves that were made
+     * @param move the move to take back
+     * @param undo the record that move() filled in when the move was made
+     */
+    void undo( const Move& move, const Undo& undo );
+
 private:
     Cell& atLocation( std::pair<int, int> location );
 
+    [[nodiscard]] std::uint16_t packFlags() const;
+
+    void unpackFlags( std::uint16_t flags );
+
     struct MovesDatabase {
         MovesDatabase();
 
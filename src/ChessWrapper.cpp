@@ -1,14 +1,26 @@
 #include "ChessWrapper.hpp"
+#include "MateSolver.hpp"
 
 using namespace godot;
 
 void ChessWrapper::_register_methods() {
     register_method( "move", &ChessWrapper::move );
+    register_method( "apply_moves", &ChessWrapper::applyMoves );
+    register_method( "status", &ChessWrapper::status );
+    register_method( "solve_mate", &ChessWrapper::solveMate );
     register_method( "board_state", &ChessWrapper::boardState );
     register_method( "is_white_turn", &ChessWrapper::isWhiteTurn );
     register_method( "is_in_check", &ChessWrapper::isInCheck );
     register_method( "is_checkmated", &ChessWrapper::isInCheckmate );
     register_method( "is_stalemated", &ChessWrapper::isStalemated );
+    register_method( "take_back", &ChessWrapper::takeBack );
+    register_method( "redo", &ChessWrapper::redo );
+    register_method( "jump_to_ply", &ChessWrapper::jumpToPly );
+    register_method( "select_variation", &ChessWrapper::selectVariation );
+    register_method( "ply", &ChessWrapper::ply );
+    register_method( "line_length", &ChessWrapper::lineLength );
+    register_method( "variation_count", &ChessWrapper::variationCount );
+    register_method( "variation_index", &ChessWrapper::variationIndex );
 }
 
 void ChessWrapper::_init() {
@@ -47,7 +59,8 @@ namespace {
 
 bool ChessWrapper::move( godot::Vector2 start, godot::Vector2 end ) {
     Godot::print( String( "Moving from " ) + start + " to " + end );
-    bool result = chess.move( { start.x, start.y }, { end.x, end.y }, true );
+    bool result = history.move( {{ (int) start.x, (int) start.y },
+                                 { (int) end.x,   (int) end.y }} );
     if ( result ) {
         convertBoardState();
         Godot::print( String( "Legal moves: " ) + Variant((int) chess.legalMoves().size()));
@@ -58,6 +71,43 @@ bool ChessWrapper::move( godot::Vector2 start, godot::Vector2 end ) {
     return result;
 }
 
+int ChessWrapper::applyMoves( godot::PoolIntArray moves ) {
+    int failed = -1;
+    {
+        auto read = moves.read();
+        for ( int i = 0; i < moves.size(); ++i ) {
+            if ( read[ i ] < 0 || read[ i ] > 0xfff || !history.move( Chess::unpackMove( read[ i ] ))) {
+                failed = i;
+                break;
+            }
+        }
+    }
+    if ( failed != 0 ) convertBoardState();
+    return failed;
+}
+
+int ChessWrapper::status() const {
+    int result = 0;
+    if ( chess.isWhiteTurn()) result |= WHITE_TURN;
+    if ( chess.isInCheck()) result |= IN_CHECK;
+    if ( chess.isInCheckmate()) result |= CHECKMATE;
+    if ( chess.isStalemated()) result |= STALEMATE;
+    if ( history.lastMoveCaptured()) result |= CAPTURED;
+    return result;
+}
+
+godot::Dictionary ChessWrapper::solveMate( int n, int timeMs ) {
+    MateSolver solver;
+    auto       result = solver.solve( chess, n, std::chrono::milliseconds{ timeMs } );
+
+    Dictionary dictionary;
+    dictionary[ "result" ]  = toString( result.outcome );
+    dictionary[ "move" ]    = result.move ? (int) Chess::packMove( *result.move ) : -1;
+    dictionary[ "nodes" ]   = (int) result.nodes;
+    dictionary[ "time_ms" ] = (int) ( result.seconds * 1000 );
+    return dictionary;
+}
+
 void ChessWrapper::convertBoardState() {
     for ( int i = 0; i < 8; ++i ) {
         for ( int j = 0; j < 8; ++j ) {
@@ -65,3 +115,27 @@ void ChessWrapper::convertBoardState() {
         }
     }
 }
+
+bool ChessWrapper::takeBack() {
+    bool result = history.takeBack();
+    if ( result ) convertBoardState();
+    return result;
+}
+
+bool ChessWrapper::redo() {
+    bool result = history.redo();
+    if ( result ) convertBoardState();
+    return result;
+}
+
+bool ChessWrapper::jumpToPly( int ply ) {
+    bool result = history.jumpToPly( ply );
+    if ( result ) convertBoardState();
+    return result;
+}
+
+bool ChessWrapper::selectVariation( int index ) {
+    bool result = history.selectVariation( index );
+    if ( result ) convertBoardState();
+    return result;
+}
@@ -5,10 +5,18 @@
 #include <Godot.hpp>
 #include <Node2D.hpp>
 #include "Chess.hpp"
+#include "GameTree.hpp"
 
 class ChessWrapper : public godot::Node2D {
 GODOT_CLASS( ChessWrapper, Node2D )
 public:
+    /**
+     * Bits of the value returned by status()
+     */
+    enum Status {
+        WHITE_TURN = 1 << 0, IN_CHECK = 1 << 1, CHECKMATE = 1 << 2, STALEMATE = 1 << 3, CAPTURED = 1 << 4
+    };
+
     static void _register_methods();
 
     void _init();
@@ -17,6 +25,26 @@ public:
 
     bool move( godot::Vector2 start, godot::Vector2 end );
 
+    /**
+     * Plays a sequence of moves without logging, each packed as (start row * 8 + start column) << 6 | (end row * 8 +
+     * end column). Stops at the first move that can't be played
+     * @return the index of that move, or -1 if every move was played
+     */
+    int applyMoves( godot::PoolIntArray moves );
+
+    /**
+     * Whose turn it is, whether they are in check, checkmated or stalemated and whether the last move captured a
+     * piece, packed as Status bits
+     */
+    [[nodiscard]] int status() const;
+
+    /**
+     * Looks for a forced mate in at most n moves for the player to move
+     * @return a dictionary with "result" ("mate", "no mate" or "unknown" if time ran out), "move" (the first move of
+     * the mate packed as in applyMoves, or -1), "nodes" and "time_ms"
+     */
+    godot::Dictionary solveMate( int n, int timeMs );
+
     [[nodiscard]] bool isWhiteTurn() const { return chess.isWhiteTurn(); }
 
     [[nodiscard]] bool isInCheck() const { return chess.isInCheck(); }
@@ -25,10 +53,27 @@ public:
 
     [[nodiscard]] bool isStalemated() const { return chess.isStalemated(); }
 
+    bool takeBack();
+
+    bool redo();
+
+    bool jumpToPly( int ply );
+
+    bool selectVariation( int index );
+
+    [[nodiscard]] int ply() const { return history.ply(); }
+
+    [[nodiscard]] int lineLength() const { return history.lineLength(); }
+
+    [[nodiscard]] int variationCount() const { return history.variationCount(); }
+
+    [[nodiscard]] int variationIndex() const { return history.variationIndex(); }
+
 private:
     void convertBoardState();
 
     Chess                  chess;
+    GameTree               history{ chess };
     godot::PoolStringArray boardState_;
 };
 
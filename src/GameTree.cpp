@@ -0,0 +1,125 @@
+#include "GameTree.hpp"
+
+GameTree::GameTree( Chess& chess ) : chess{ chess } {
+    // the root stands for the starting position and holds no move
+    nodes.push_back( { NONE, NONE, NONE, 0, 0, {}} );
+}
+
+bool GameTree::move( const Chess::Move& move ) {
+    auto packed = Chess::packMove( move );
+
+    // if the move was played from here before, enter the existing variation
+    std::uint32_t last = NONE;
+    for ( auto child = nodes[ current ].firstChild; child != NONE; child = nodes[ child ].nextSibling ) {
+        if ( nodes[ child ].move == packed ) {
+            if ( !make( child )) return false;
+            if ( ancestorAt( tip, nodes[ child ].ply ) != child ) tip = child;
+            return true;
+        }
+        last = child;
+    }
+
+    Node node{ current, NONE, NONE, packed, static_cast<std::uint16_t>(nodes[ current ].ply + 1), {}};
+    if ( !chess.move( move.start, move.end, true, &node.undo )) return false;
+
+    auto index = static_cast<std::uint32_t>(nodes.size());
+    nodes.push_back( node );
+    if ( last == NONE )
+        nodes[ current ].firstChild = index;
+    else
+        nodes[ last ].nextSibling = index;
+    current = tip = index;
+    return true;
+}
+
+bool GameTree::takeBack() {
+    if ( current == 0 ) return false;
+    unmake();
+    return true;
+}
+
+bool GameTree::redo() {
+    if ( nodes[ tip ].ply > nodes[ current ].ply )
+        return goTo( ancestorAt( tip, nodes[ current ].ply + 1 ));
+
+    auto child = nodes[ current ].firstChild;
+    if ( child == NONE || !make( child )) return false;
+    tip = child;
+    return true;
+}
+
+bool GameTree::jumpToPly( int ply ) {
+    if ( ply < 0 || ply > lineLength()) return false;
+    return goTo( ancestorAt( tip, ply ));
+}
+
+bool GameTree::selectVariation( int index ) {
+    if ( current == 0 || index < 0 ) return false;
+
+    auto child = nodes[ nodes[ current ].parent ].firstChild;
+    for ( ; child != NONE && index > 0; --index )
+        child = nodes[ child ].nextSibling;
+    if ( child == NONE ) return false;
+
+    if ( !goTo( child )) return false;
+    tip = child;
+    return true;
+}
+
+bool GameTree::lastMoveCaptured() const {
+    return current != 0 && static_cast<Chess::State>(nodes[ current ].undo.captured >> 3) != Chess::State::EMPTY;
+}
+
+int GameTree::variationCount() const {
+    if ( current == 0 ) return 1;
+    int count = 0;
+    for ( auto child = nodes[ nodes[ current ].parent ].firstChild; child != NONE; child = nodes[ child ].nextSibling )
+        ++count;
+    return count;
+}
+
+int GameTree::variationIndex() const {
+    if ( current == 0 ) return 0;
+    int index = 0;
+    for ( auto child = nodes[ nodes[ current ].parent ].firstChild; child != current; child = nodes[ child ].nextSibling )
+        ++index;
+    return index;
+}
+
+bool GameTree::make( std::uint32_t node ) {
+    auto move = Chess::unpackMove( nodes[ node ].move );
+    if ( !chess.move( move.start, move.end, true, &nodes[ node ].undo )) return false;
+    current = node;
+    return true;
+}
+
+void GameTree::unmake() {
+    chess.undo( Chess::unpackMove( nodes[ current ].move ), nodes[ current ].undo );
+    current = nodes[ current ].parent;
+}
+
+bool GameTree::goTo( std::uint32_t node ) {
+    // collect the path down from the common ancestor, taking back moves on the way up to it
+    std::vector<std::uint32_t> path;
+    while ( nodes[ node ].ply > nodes[ current ].ply ) {
+        path.push_back( node );
+        node = nodes[ node ].parent;
+    }
+    while ( nodes[ current ].ply > nodes[ node ].ply )
+        unmake();
+    while ( current != node ) {
+        unmake();
+        path.push_back( node );
+        node = nodes[ node ].parent;
+    }
+
+    for ( auto it = path.rbegin(); it != path.rend(); ++it )
+        if ( !make( *it )) return false;
+    return true;
+}
+
+std::uint32_t GameTree::ancestorAt( std::uint32_t node, int ply ) const {
+    while ( nodes[ node ].ply > ply )
+        node = nodes[ node ].parent;
+    return node;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Chess.hpp"
+
+/**
+ * History of a game as a tree of variations. Nodes live in one contiguous arena and refer to each other by index, each
+ * holding a packed move and the record needed to take it back, so moving around the tree costs one make or unmake per
+ * ply travelled instead of replaying the game from the start
+ */
+class GameTree {
+public:
+    explicit GameTree( Chess& chess );
+
+    GameTree( const GameTree& ) = delete;
+
+    /**
+     * Plays a move from the current position. If the move was already played from here the existing variation is
+     * entered, otherwise a new variation is added after the existing ones
+     * @return false if the move is illegal
+     */
+    bool move( const Chess::Move& move );
+
+    bool takeBack();
+
+    /**
+     * Steps forward along the current line, or into the first variation once past its end
+     */
+    bool redo();
+
+    /**
+     * Moves to the given ply on the current line
+     */
+    bool jumpToPly( int ply );
+
+    /**
+     * Switches to another variation of the last move, i.e. one of the siblings of the current node
+     * @param index position of the variation among its siblings, 0 being the main line
+     */
+    bool selectVariation( int index );
+
+    [[nodiscard]] int ply() const { return nodes[ current ].ply; }
+
+    /**
+     * Number of plies on the current line, including the ones after the current position
+     */
+    [[nodiscard]] int lineLength() const { return nodes[ tip ].ply; }
+
+    [[nodiscard]] bool lastMoveCaptured() const;
+
+    [[nodiscard]] int variationCount() const;
+
+    [[nodiscard]] int variationIndex() const;
+
+    [[nodiscard]] std::size_t size() const { return nodes.size(); }
+
+private:
+    static constexpr std::uint32_t NONE = UINT32_MAX;
+
+    struct Node {
+        std::uint32_t parent;
+        std::uint32_t firstChild;
+        std::uint32_t nextSibling;
+        std::uint16_t move;
+        std::uint16_t ply;
+        Chess::Undo   undo;
+    };
+
+    bool make( std::uint32_t node );
+
+    void unmake();
+
+    /**
+     * Travels from the current node to the given one through their common ancestor
+     */
+    bool goTo( std::uint32_t node );
+
+    [[nodiscard]] std::uint32_t ancestorAt( std::uint32_t node, int ply ) const;
+
+    Chess& chess;
+    std::vector<Node> nodes;
+    std::uint32_t     current = 0;
+    std::uint32_t     tip     = 0;
+};
@@ -0,0 +1,152 @@
+#include "MateSolver.hpp"
+
+#include <algorithm>
+
+namespace {
+    std::uint32_t add( std::uint32_t a, std::uint32_t b, std::uint32_t infinite ) {
+        if ( a >= infinite || b >= infinite ) return infinite;
+        return std::min( a + b, infinite - 1 );
+    }
+}
+
+const char* toString( MateSolver::Outcome outcome ) {
+    switch ( outcome ) {
+        case MateSolver::Outcome::MATE:return "mate";
+        case MateSolver::Outcome::NO_MATE:return "no mate";
+        case MateSolver::Outcome::UNKNOWN:return "unknown";
+    }
+    return "unknown";
+}
+
+MateSolver::MateSolver( std::size_t tableMegabytes ) {
+    // round down to a power of two so a key can be masked into an index
+    std::size_t size = 1;
+    while ( size * 2 * sizeof( Entry ) <= tableMegabytes * 1024 * 1024 ) size *= 2;
+    table.resize( size );
+}
+
+MateSolver::Result MateSolver::solve( const Chess& position, int moves, std::chrono::milliseconds timeLimit ) {
+    auto  started = std::chrono::steady_clock::now();
+    Chess chess{ position };
+    deadline = started + timeLimit;
+    nodes    = 0;
+    aborted  = false;
+    moves    = std::max( moves, 0 );
+    std::fill( table.begin(), table.end(), Entry{} );
+
+    auto root = search( chess, key( chess, moves ), moves, true, INFINITE, INFINITE );
+
+    Result result{ Outcome::UNKNOWN, {}, nodes, 0 };
+    if ( root.proof == 0 ) {
+        result.outcome = Outcome::MATE;
+        for ( const auto& child: expand( chess, moves - 1, false )) {
+            auto entry = lookup( child.key );
+            if ( entry && entry->proof == 0 ) {
+                result.move = child.move;
+                break;
+            }
+        }
+    }
+    else if ( root.disproof == 0 ) {
+        result.outcome = Outcome::NO_MATE;
+    }
+    result.seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - started ).count();
+    return result;
+}
+
+std::uint64_t MateSolver::key( const Chess& chess, int moves ) {
+    return chess.hash() ^ static_cast<std::uint64_t>(moves + 1) * 0x9e3779b97f4a7c15;
+}
+
+const MateSolver::Entry* MateSolver::lookup( std::uint64_t key ) const {
+    const auto& entry = table[ key & ( table.size() - 1 ) ];
+    if ( entry.key == key && ( entry.proof != 0 || entry.disproof != 0 )) return &entry;
+    return nullptr;
+}
+
+MateSolver::Entry MateSolver::store( std::uint64_t key, std::uint32_t proof, std::uint32_t disproof ) {
+    return table[ key & ( table.size() - 1 ) ] = { key, proof, disproof };
+}
+
+std::vector<MateSolver::Child> MateSolver::expand( Chess& chess, int childMoves, bool firstOnly ) {
+    std::vector<Child> children;
+    for ( const auto& move: chess.legalMoves()) {
+        if ( std::any_of( children.begin(), children.end(), [ & ]( const Child& c ) { return c.move == move; } ))
+            continue;
+        Chess::Undo undo;
+        if ( !chess.move( move.start, move.end, false, &undo )) continue;
+        children.push_back( { move, key( chess, childMoves ) } );
+        chess.undo( move, undo );
+        if ( firstOnly ) break;
+    }
+    return children;
+}
+
+MateSolver::Entry MateSolver::search( Chess& chess, std::uint64_t key, int moves, bool attacker,
+                                      std::uint32_t phiThreshold, std::uint32_t deltaThreshold ) {
+    ++nodes;
+    if ( std::chrono::steady_clock::now() > deadline ) aborted = true;
+    if ( aborted ) {
+        auto entry = lookup( key );
+        return entry ? *entry : Entry{ key, 1, 1 };
+    }
+
+    // the attacker has run out of moves
+    if ( attacker && moves == 0 ) return store( key, INFINITE, 0 );
+
+    // once the attacker is out of moves any reply from the defender refutes, so one is enough
+    bool lastReply = !attacker && moves == 0;
+    auto children  = expand( chess, attacker ? moves - 1 : moves, lastReply );
+    if ( children.empty()) {
+        // only the defender being checkmated proves anything
+        if ( !attacker && chess.isInCheck()) return store( key, 0, INFINITE );
+        return store( key, INFINITE, 0 );
+    }
+    if ( lastReply ) return store( key, INFINITE, 0 );
+
+    // the children's numbers are kept here as well in case the table loses them to a collision
+    std::vector<Entry> values;
+    values.reserve( children.size());
+    for ( const auto& child: children )
+        values.push_back( { child.key, 1, 1 } );
+
+    // phi and delta are the proof and disproof numbers from the point of view of the player to move, so the node is
+    // solved for them when phi reaches 0 and for the opponent when delta does
+    while ( true ) {
+        std::uint32_t phi         = INFINITE;
+        std::uint32_t delta       = 0;
+        std::uint32_t secondDelta = INFINITE;
+        std::uint32_t bestPhi     = 0;
+        std::size_t   best        = 0;
+        for ( std::size_t i = 0; i < children.size(); ++i ) {
+            if ( auto entry = lookup( children[ i ].key )) values[ i ] = *entry;
+            auto childPhi   = attacker ? values[ i ].disproof : values[ i ].proof;
+            auto childDelta = attacker ? values[ i ].proof : values[ i ].disproof;
+            delta = add( delta, childPhi, INFINITE );
+            if ( childDelta < phi ) {
+                secondDelta = phi;
+                phi         = childDelta;
+                best        = i;
+                bestPhi     = childPhi;
+            }
+            else if ( childDelta < secondDelta ) {
+                secondDelta = childDelta;
+            }
+        }
+
+        auto entry = attacker ? store( key, phi, delta ) : store( key, delta, phi );
+        if ( phi >= phiThreshold || delta >= deltaThreshold || aborted ) return entry;
+
+        // give the most promising child as much room as possible without overtaking the second best
+        auto childPhiThreshold   = static_cast<std::uint32_t>(std::min<std::uint64_t>(
+                static_cast<std::uint64_t>(deltaThreshold) - delta + bestPhi, INFINITE ));
+        auto childDeltaThreshold = std::min( phiThreshold, add( secondDelta, 1, INFINITE ));
+
+        const auto& move = children[ best ].move;
+        Chess::Undo undo;
+        chess.move( move.start, move.end, false, &undo );
+        values[ best ] = search( chess, children[ best ].key, attacker ? moves - 1 : moves, !attacker,
+                                 childPhiThreshold, childDeltaThreshold );
+        chess.undo( move, undo );
+    }
+}
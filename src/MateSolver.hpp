@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "Chess.hpp"
+
+/**
+ * Proves or disproves that the player to move can force mate within a number of moves, using depth-first
+ * proof-number search (df-pn). Positions are tracked in a fixed-size transposition table, so memory use doesn't grow
+ * with the length of the search
+ */
+class MateSolver {
+public:
+    enum class Outcome {
+        MATE, NO_MATE, UNKNOWN
+    };
+
+    struct Result {
+        Outcome                    outcome;
+        std::optional<Chess::Move> move;  // first move of the mate, if one was found
+        std::uint64_t              nodes;
+        double                     seconds;
+    };
+
+    explicit MateSolver( std::size_t tableMegabytes = 16 );
+
+    /**
+     * Searches a copy of the position, so the caller's game is left alone
+     * @param moves number of moves the player to move gets to deliver mate
+     * @param timeLimit the outcome is UNKNOWN if this runs out first
+     */
+    Result solve( const Chess& position, int moves, std::chrono::milliseconds timeLimit );
+
+private:
+    static constexpr std::uint32_t INFINITE = 100'000'000;
+
+    struct Entry {
+        std::uint64_t key;
+        std::uint32_t proof;
+        std::uint32_t disproof;
+    };
+
+    struct Child {
+        Chess::Move   move;
+        std::uint64_t key;
+    };
+
+    /**
+     * Key of a position together with the number of moves the attacker has left
+     */
+    static std::uint64_t key( const Chess& chess, int moves );
+
+    [[nodiscard]] const Entry* lookup( std::uint64_t key ) const;
+
+    Entry store( std::uint64_t key, std::uint32_t proof, std::uint32_t disproof );
+
+    /**
+     * Legal moves from the current position, stopping after the first one if firstOnly is set
+     */
+    std::vector<Child> expand( Chess& chess, int childMoves, bool firstOnly );
+
+    /**
+     * Searches the current position until its proof number reaches phiThreshold or its disproof number reaches
+     * deltaThreshold, from the point of view of the player to move
+     * @return the proof and disproof numbers of the position
+     */
+    Entry search( Chess& chess, std::uint64_t key, int moves, bool attacker,
+                  std::uint32_t phiThreshold, std::uint32_t deltaThreshold );
+
+    std::vector<Entry>                    table;
+    std::chrono::steady_clock::time_point deadline;
+    std::uint64_t                         nodes   = 0;
+    bool                                  aborted = false;
+};
+
+const char* toString( MateSolver::Outcome outcome );
@@ -0,0 +1,106 @@
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include "MateSolver.hpp"
+
+namespace {
+    int usage( const char* name ) {
+        std::cerr << "Usage: " << name << " <fen> <moves> [--time MS]\n"
+                  << "       " << name << " --bench <puzzle file> [--time MS]\n"
+                  << "Puzzle files hold one puzzle per line as '<fen>; <moves>; <mate|no mate>', lines starting with #\n"
+                  << "are ignored\n";
+        return EXIT_FAILURE;
+    }
+
+    std::string toString( const Chess::Move& move ) {
+        return { static_cast<char>('a' + move.start.second), static_cast<char>('8' - move.start.first),
+                 static_cast<char>('a' + move.end.second), static_cast<char>('8' - move.end.first) };
+    }
+
+    std::string trim( const std::string& text ) {
+        auto begin = text.find_first_not_of( " \t\r" );
+        if ( begin == std::string::npos ) return {};
+        return text.substr( begin, text.find_last_not_of( " \t\r" ) - begin + 1 );
+    }
+
+    void print( const MateSolver::Result& result ) {
+        std::cout << toString( result.outcome );
+        if ( result.move ) std::cout << ' ' << toString( *result.move );
+        std::cout << ", " << result.nodes << " nodes in " << result.seconds * 1000 << " ms";
+    }
+
+    int bench( const std::string& path, std::chrono::milliseconds timeLimit ) {
+        std::ifstream in{ path };
+        if ( !in ) {
+            std::cerr << "Can't open " << path << '\n';
+            return EXIT_FAILURE;
+        }
+
+        MateSolver    solver;
+        int           puzzles = 0;
+        int           solved  = 0;
+        std::uint64_t nodes   = 0;
+        double        seconds = 0;
+        std::string   line;
+        for ( int lineNumber = 1; std::getline( in, line ); ++lineNumber ) {
+            if ( line.empty() || line.front() == '#' ) continue;
+            auto first    = line.find( ';' );
+            auto second   = first == std::string::npos ? first : line.find( ';', first + 1 );
+            auto expected = second == std::string::npos ? std::string{} : trim( line.substr( second + 1 ));
+            if ( expected != toString( MateSolver::Outcome::MATE ) &&
+                 expected != toString( MateSolver::Outcome::NO_MATE )) {
+                std::cerr << path << ':' << lineNumber << ": expected '<fen>; <moves>; <mate|no mate>'\n";
+                return EXIT_FAILURE;
+            }
+
+            Chess chess{ line.substr( 0, first ) };
+            int   moves  = std::stoi( line.substr( first + 1, second - first - 1 ));
+            auto  result = solver.solve( chess, moves, timeLimit );
+            std::cout << path << ':' << lineNumber << ": mate in " << moves << ": ";
+            print( result );
+            if ( expected != toString( result.outcome )) std::cout << ", expected " << expected;
+            std::cout << '\n';
+
+            ++puzzles;
+            if ( expected == toString( result.outcome )) ++solved;
+            nodes += result.nodes;
+            seconds += result.seconds;
+        }
+
+        std::cout << solved << '/' << puzzles << " solved, " << nodes << " nodes in " << seconds * 1000 << " ms";
+        if ( seconds > 0 ) std::cout << " (" << nodes / seconds << " nodes/s)";
+        std::cout << '\n';
+        return solved == puzzles ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+}
+
+int main( int argc, char** argv ) {
+    if ( argc < 3 ) return usage( argv[ 0 ] );
+
+    std::chrono::milliseconds timeLimit{ 10000 };
+    for ( int i = 3; i < argc; ++i ) {
+        std::string arg = argv[ i ];
+        if ( arg == "--time" && i + 1 < argc )
+            timeLimit = std::chrono::milliseconds{ std::stol( argv[ ++i ] ) };
+        else
+            return usage( argv[ 0 ] );
+    }
+
+    try {
+        if ( std::string{ argv[ 1 ] } == "--bench" ) return bench( argv[ 2 ], timeLimit );
+
+        Chess      chess{ argv[ 1 ] };
+        MateSolver solver;
+        auto       result = solver.solve( chess, std::stoi( argv[ 2 ] ), timeLimit );
+        print( result );
+        std::cout << '\n';
+        return result.outcome == MateSolver::Outcome::UNKNOWN ? EXIT_FAILURE : EXIT_SUCCESS;
+    }
+    catch ( const std::exception& e ) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,457 @@
+#include "PgnImport.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <system_error>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const char* toString( PgnError::Kind kind ) {
+    switch ( kind ) {
+        case PgnError::Kind::SYNTAX:return "syntax error";
+        case PgnError::Kind::ILLEGAL:return "illegal move";
+        case PgnError::Kind::AMBIGUOUS:return "ambiguous move";
+        case PgnError::Kind::UNSUPPORTED:return "unsupported move";
+    }
+    return "unknown error";
+}
+
+void PgnCounter::game( const PgnGame& game ) {
+    ++games;
+    plies += game.moves.size();
+}
+
+void PgnCounter::error( const PgnError& ) {
+    ++errors;
+}
+
+PgnArchiveWriter::PgnArchiveWriter( const std::string& path ) : path{ path }, out{ path, std::ios::binary } {
+    check();
+}
+
+void PgnArchiveWriter::game( const PgnGame& game ) {
+    auto offset = static_cast<std::uint64_t>(game.offset);
+    auto plies  = static_cast<std::uint16_t>(game.moves.size());
+    out.write( reinterpret_cast<const char*>(&offset), sizeof offset );
+    out.write( reinterpret_cast<const char*>(&plies), sizeof plies );
+    out.write( reinterpret_cast<const char*>(game.moves.data()), plies * sizeof( std::uint16_t ));
+    check();
+}
+
+void PgnArchiveWriter::finish() {
+    out.flush();
+    check();
+}
+
+void PgnArchiveWriter::check() {
+    if ( !out ) throw std::system_error( errno ? errno : EIO, std::generic_category(), path );
+}
+
+namespace {
+    bool isSpace( char c ) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    bool isResult( std::string_view token ) {
+        return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+    }
+
+    /**
+     * A move in standard algebraic notation, with rows and columns as Chess uses them
+     */
+    struct San {
+        Chess::Pieces piece      = Chess::Pieces::PAWN;
+        int           fromRow    = -1;
+        int           fromColumn = -1;
+        int           toRow      = -1;
+        int           toColumn   = -1;
+        int           castle     = -1; // column the king lands on when castling
+        char          promotion  = 0;
+    };
+
+    bool isFile( char c ) { return c >= 'a' && c <= 'h'; }
+
+    bool isRank( char c ) { return c >= '1' && c <= '8'; }
+
+    std::optional<San> parseSan( std::string_view token ) {
+        San san;
+        while ( !token.empty() && std::strchr( "+#!?", token.back()))
+            token.remove_suffix( 1 );
+
+        if ( token == "O-O" || token == "0-0" ) {
+            san.piece  = Chess::Pieces::KING;
+            san.castle = 6;
+            return san;
+        }
+        if ( token == "O-O-O" || token == "0-0-0" ) {
+            san.piece  = Chess::Pieces::KING;
+            san.castle = 2;
+            return san;
+        }
+        if ( token.empty()) return {};
+
+        switch ( token.front()) {
+            case 'K':san.piece = Chess::Pieces::KING;
+                break;
+            case 'Q':san.piece = Chess::Pieces::QUEEN;
+                break;
+            case 'R':san.piece = Chess::Pieces::ROOK;
+                break;
+            case 'B':san.piece = Chess::Pieces::BISHOP;
+                break;
+            case 'N':san.piece = Chess::Pieces::KNIGHT;
+                break;
+            default:break;
+        }
+        if ( san.piece != Chess::Pieces::PAWN ) token.remove_prefix( 1 );
+
+        if ( auto equals = token.find( '=' ); equals != std::string_view::npos ) {
+            if ( equals + 2 != token.size()) return {};
+            san.promotion = token.back();
+            token.remove_suffix( 2 );
+        }
+        else if ( san.piece == Chess::Pieces::PAWN && !token.empty() && std::strchr( "QRBN", token.back())) {
+            san.promotion = token.back();
+            token.remove_suffix( 1 );
+        }
+
+        // what's left is the destination, optionally preceded by the file and/or rank the piece comes from
+        char squares[4];
+        int  count = 0;
+        for ( char c: token ) {
+            if ( c == 'x' || c == '-' ) continue;
+            if ( count == 4 ) return {};
+            squares[ count++ ] = c;
+        }
+        if ( count < 2 || !isFile( squares[ count - 2 ] ) || !isRank( squares[ count - 1 ] )) return {};
+        san.toColumn = squares[ count - 2 ] - 'a';
+        san.toRow    = '8' - squares[ count - 1 ];
+        for ( int i = 0; i < count - 2; ++i ) {
+            if ( isFile( squares[ i ] ))
+                san.fromColumn = squares[ i ] - 'a';
+            else if ( isRank( squares[ i ] ))
+                san.fromRow = '8' - squares[ i ];
+            else
+                return {};
+        }
+
+        // a pawn that doesn't capture stays on its file
+        if ( san.piece == Chess::Pieces::PAWN && san.fromColumn == -1 ) san.fromColumn = san.toColumn;
+        return san;
+    }
+
+    /**
+     * Finds the move a SAN token stands for among the legal moves and plays it
+     * @return the reason the move couldn't be played, if it couldn't
+     */
+    std::optional<PgnError::Kind> play( Chess& chess, const San& san, std::uint16_t& played ) {
+        // Chess always promotes to a queen
+        if ( san.promotion != 0 && san.promotion != 'Q' ) return PgnError::Kind::UNSUPPORTED;
+
+        // and has no en passant, the only way a pawn captures onto an empty square
+        if ( san.piece == Chess::Pieces::PAWN && san.fromColumn != san.toColumn &&
+             chess.boardState()[ san.toRow ][ san.toColumn ].state == Chess::State::EMPTY )
+            return PgnError::Kind::UNSUPPORTED;
+
+        auto                     color = chess.isWhiteTurn() ? Chess::State::WHITE : Chess::State::BLACK;
+        std::vector<Chess::Move> candidates;
+        if ( san.castle != -1 ) {
+            int row = chess.isWhiteTurn() ? 7 : 0;
+            candidates.push_back( {{ row, 4 },
+                                   { row, san.castle }} );
+        }
+        else {
+            for ( const auto& move: chess.legalMoves()) {
+                if ( move.end != std::pair{ san.toRow, san.toColumn } ) continue;
+                const auto& cell = chess.boardState()[ move.start.first ][ move.start.second ];
+                if ( cell.state != color || cell.piece != san.piece ) continue;
+                if ( san.fromRow != -1 && move.start.first != san.fromRow ) continue;
+                if ( san.fromColumn != -1 && move.start.second != san.fromColumn ) continue;
+                if ( std::find( candidates.begin(), candidates.end(), move ) != candidates.end()) continue;
+                candidates.push_back( move );
+            }
+        }
+
+        // only pseudo-legal moves are stored, so weed out the ones that leave the king in check
+        if ( candidates.size() > 1 ) {
+            std::erase_if( candidates, [ & ]( const Chess::Move& move ) {
+                Chess::Undo undo;
+                if ( !chess.move( move.start, move.end, false, &undo )) return true;
+                chess.undo( move, undo );
+                return false;
+            } );
+        }
+        if ( candidates.size() > 1 ) return PgnError::Kind::AMBIGUOUS;
+        if ( candidates.empty()) return PgnError::Kind::ILLEGAL;
+
+        // move() still rejects moves that leave the king in check, so the costly search for mate and stalemate can
+        // be skipped; nothing is played after either, so a move following one fails as illegal anyway
+        const auto& move = candidates.front();
+        if ( !chess.move( move.start, move.end, false )) return PgnError::Kind::ILLEGAL;
+        played = Chess::packMove( move );
+        return {};
+    }
+
+    struct Output {
+        PgnSink&       sink;
+        std::mutex     mutex;
+        PgnImportStats stats;
+    };
+
+    /**
+     * Replays the game in [begin, end) and hands it or its first error to the sink
+     */
+    void replay( const char* data, std::size_t begin, std::size_t end, PgnGame& game, Output& output ) {
+        game.offset = begin;
+        game.text   = { data + begin, end - begin };
+        game.moves.clear();
+
+        auto fail = [ & ]( PgnError::Kind kind, std::size_t offset, std::string_view token ) {
+            std::lock_guard lock{ output.mutex };
+            ++output.stats.errors;
+            output.sink.error( { kind, begin, offset, static_cast<int>(game.moves.size()), std::string{ token }} );
+        };
+
+        // skip a byte order mark and the tag section
+        auto position = begin;
+        if ( begin == 0 && end >= 3 && std::memcmp( data, "\xEF\xBB\xBF", 3 ) == 0 ) position = 3;
+        while ( true ) {
+            while ( position < end && isSpace( data[ position ] )) ++position;
+            if ( position == end || data[ position ] != '[' ) break;
+            while ( position < end && data[ position ] != '\n' ) ++position;
+        }
+
+        Chess chess;
+        bool  finished = false;
+        while ( position < end ) {
+            char c = data[ position ];
+            if ( isSpace( c )) {
+                ++position;
+            }
+            else if ( c == '{' ) {
+                while ( position < end && data[ position ] != '}' ) ++position;
+                ++position;
+            }
+            else if ( c == ';' || ( c == '%' && data[ position - 1 ] == '\n' )) {
+                while ( position < end && data[ position ] != '\n' ) ++position;
+            }
+            else if ( c == '(' ) {
+                // variations can't be checked without branching the game, so skip them along with their comments
+                int depth = 0;
+                for ( ; position < end; ++position ) {
+                    if ( data[ position ] == '{' ) {
+                        while ( position < end && data[ position ] != '}' ) ++position;
+                        if ( position == end ) break;
+                    }
+                    else if ( data[ position ] == '(' ) ++depth;
+                    else if ( data[ position ] == ')' && --depth == 0 ) break;
+                }
+                ++position;
+            }
+            else if ( c == '$' ) {
+                ++position;
+                while ( position < end && data[ position ] >= '0' && data[ position ] <= '9' ) ++position;
+            }
+            else {
+                auto tokenBegin = position;
+                while ( position < end && !isSpace( data[ position ] ) && !std::strchr( "{}();$", data[ position ] ))
+                    ++position;
+                // a stray ) or } or a NUL byte stops the token before it starts
+                if ( position == tokenBegin ) return fail( PgnError::Kind::SYNTAX, position, { data + position, 1 } );
+                std::string_view token{ data + tokenBegin, position - tokenBegin };
+
+                if ( isResult( token )) {
+                    finished = true;
+                    break;
+                }
+
+                // strip the move number
+                if ( token.front() >= '0' && token.front() <= '9' ) {
+                    auto number = token.find_first_not_of( "0123456789" );
+                    if ( number == std::string_view::npos || token[ number ] != '.' )
+                        return fail( PgnError::Kind::SYNTAX, tokenBegin, token );
+                    auto move = token.find_first_not_of( '.', number );
+                    if ( move == std::string_view::npos ) continue;
+                    tokenBegin += move;
+                    token.remove_prefix( move );
+                }
+
+                auto san = parseSan( token );
+                if ( !san ) return fail( PgnError::Kind::SYNTAX, tokenBegin, token );
+                std::uint16_t played = 0;
+                if ( auto error = play( chess, *san, played ))
+                    return fail( *error, tokenBegin, token );
+                game.moves.push_back( played );
+            }
+        }
+
+        // a game that runs out before its result was probably cut in two
+        if ( !finished ) return fail( PgnError::Kind::SYNTAX, end, {} );
+
+        std::lock_guard lock{ output.mutex };
+        ++output.stats.games;
+        output.stats.plies += game.moves.size();
+        output.sink.game( game );
+    }
+}
+
+PgnImporter::PgnImporter( const std::string& path ) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                               FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+    if ( file == INVALID_HANDLE_VALUE )
+        throw std::system_error( (int) GetLastError(), std::system_category(), path );
+    LARGE_INTEGER fileSize;
+    if ( !GetFileSizeEx( file, &fileSize )) {
+        DWORD error = GetLastError();
+        CloseHandle( file );
+        throw std::system_error( (int) error, std::system_category(), path );
+    }
+    size = static_cast<std::size_t>(fileSize.QuadPart);
+    if ( size == 0 ) {
+        CloseHandle( file );
+        return;
+    }
+    // like mmap, the view stays valid once the handles it was made from are closed
+    HANDLE mapping = CreateFileMappingA( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+    DWORD  error   = GetLastError();
+    CloseHandle( file );
+    if ( !mapping ) throw std::system_error( (int) error, std::system_category(), path );
+    data  = static_cast<const char*>(MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 ));
+    error = GetLastError();
+    CloseHandle( mapping );
+    if ( !data ) throw std::system_error( (int) error, std::system_category(), path );
+#else
+    int fd = open( path.c_str(), O_RDONLY );
+    if ( fd == -1 ) throw std::system_error( errno, std::generic_category(), path );
+    struct stat info{};
+    if ( fstat( fd, &info ) == -1 ) {
+        int error = errno;
+        close( fd );
+        throw std::system_error( error, std::generic_category(), path );
+    }
+    size = static_cast<std::size_t>(info.st_size);
+    if ( size == 0 ) {
+        close( fd );
+        return;
+    }
+    void* mapped = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    int error = errno;
+    close( fd );
+    if ( mapped == MAP_FAILED ) throw std::system_error( error, std::generic_category(), path );
+    madvise( mapped, size, MADV_SEQUENTIAL );
+    data = static_cast<const char*>(mapped);
+#endif
+}
+
+PgnImporter::~PgnImporter() {
+#ifdef _WIN32
+    if ( data ) UnmapViewOfFile( data );
+#else
+    if ( data ) munmap( const_cast<char*>(data), size );
+#endif
+}
+
+PgnImportStats PgnImporter::run( PgnSink& sink, unsigned threads, std::size_t chunkSize ) {
+    auto started = std::chrono::steady_clock::now();
+    if ( threads == 0 ) threads = std::max( 1u, std::thread::hardware_concurrency());
+    chunkSize = std::max<std::size_t>( chunkSize, 1 );
+
+    Output                   output{ sink, {}, {} };
+    std::atomic<std::size_t> nextChunk{ 0 };
+    std::exception_ptr       failure;
+    std::mutex               failureMutex;
+
+    // each worker claims chunks in turn and replays the games that start inside them, reading past the end of the
+    // chunk to finish the last one
+    const auto work = [ & ] {
+        try {
+            PgnGame game;
+            for ( auto chunk = nextChunk++; chunk * chunkSize < size; chunk = nextChunk++ ) {
+                auto chunkEnd = std::min( size, ( chunk + 1 ) * chunkSize );
+                auto begin    = nextGameStart( chunk * chunkSize );
+                // text before the first tag pair is replayed as a game without tags rather than dropped
+                if ( chunk == 0 && std::any_of( data, data + begin, []( char c ) { return !isSpace( c ); } ))
+                    begin = 0;
+                while ( begin < chunkEnd ) {
+                    auto end = nextGameStart( begin + 1 );
+                    replay( data, begin, end, game, output );
+                    begin = end;
+                }
+            }
+        }
+        catch ( ... ) {
+            std::lock_guard lock{ failureMutex };
+            if ( !failure ) failure = std::current_exception();
+            nextChunk = size;
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for ( unsigned i = 1; i < threads; ++i )
+        workers.emplace_back( work );
+    work();
+    for ( auto& worker: workers )
+        worker.join();
+    if ( failure ) std::rethrow_exception( failure );
+    sink.finish();
+
+    output.stats.bytes   = size;
+    output.stats.seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - started ).count();
+    return output.stats;
+}
+
+bool PgnImporter::isGameStart( std::size_t position ) const {
+    if ( data[ position ] != '[' ) return false;
+    if ( position != 0 && data[ position - 1 ] != '\n' ) return false;
+
+    // the line has to be a whole tag pair, [Name "value"], so comments like [%clk 0:03:00] don't count
+    auto tag = position + 1;
+    while ( tag < size && ( std::isalnum( static_cast<unsigned char>(data[ tag ] )) || data[ tag ] == '_' )) ++tag;
+    if ( tag == position + 1 ) return false;
+    while ( tag < size && ( data[ tag ] == ' ' || data[ tag ] == '\t' )) ++tag;
+    if ( tag == size || data[ tag ] != '"' ) return false;
+    for ( ++tag; tag < size && data[ tag ] != '"' && data[ tag ] != '\n'; ++tag )
+        if ( data[ tag ] == '\\' ) ++tag;
+    if ( tag >= size || data[ tag ] != '"' ) return false;
+    ++tag;
+    while ( tag < size && ( data[ tag ] == ' ' || data[ tag ] == '\t' )) ++tag;
+    if ( tag == size || data[ tag ] != ']' ) return false;
+
+    // and it has to follow the start of the file, a blank line or a game result, not another tag or movetext
+    auto previous = position;
+    int  newlines = 0;
+    while ( previous > 0 && isSpace( data[ previous - 1 ] ))
+        if ( data[ --previous ] == '\n' ) ++newlines;
+    if ( previous == 0 || newlines >= 2 ) return true;
+
+    auto wordBegin = previous;
+    while ( wordBegin > 0 && !isSpace( data[ wordBegin - 1 ] )) --wordBegin;
+    return isResult( { data + wordBegin, previous - wordBegin } );
+}
+
+std::size_t PgnImporter::nextGameStart( std::size_t position ) const {
+    while ( position < size && !isGameStart( position )) {
+        auto newline = static_cast<const char*>(std::memchr( data + position, '\n', size - position ));
+        if ( !newline ) return size;
+        position = newline - data + 1;
+    }
+    return std::min( position, size );
+}
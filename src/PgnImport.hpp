@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "Chess.hpp"
+
+/**
+ * A game that was replayed successfully. Only valid for the duration of the sink call it is passed to
+ */
+struct PgnGame {
+    std::size_t                offset; // offset of the game's first tag in the file
+    std::string_view           text;   // the game as it appears in the file
+    std::vector<std::uint16_t> moves;  // moves packed with Chess::packMove
+};
+
+struct PgnError {
+    enum class Kind {
+        SYNTAX, ILLEGAL, AMBIGUOUS, UNSUPPORTED
+    };
+
+    Kind        kind;
+    std::size_t gameOffset; // offset of the game's first tag in the file
+    std::size_t offset;     // offset of the offending token in the file
+    int         ply;
+    std::string token;      // empty if the game ended without a result
+};
+
+const char* toString( PgnError::Kind kind );
+
+struct PgnImportStats {
+    std::size_t games  = 0;
+    std::size_t errors = 0;
+    std::size_t plies  = 0;
+    std::size_t bytes  = 0;
+    double      seconds = 0;
+
+    [[nodiscard]] double gamesPerSecond() const { return seconds > 0 ? games / seconds : 0; }
+};
+
+/**
+ * Receives the output of a PgnImporter. Calls are made from the worker threads but never concurrently, and games are
+ * not delivered in file order
+ */
+class PgnSink {
+public:
+    virtual ~PgnSink() = default;
+
+    virtual void game( const PgnGame& game ) = 0;
+
+    virtual void error( const PgnError& ) {}
+
+    /**
+     * Called by PgnImporter::run after the last game, so output can be flushed before the run counts as a success
+     */
+    virtual void finish() {}
+};
+
+class PgnCounter : public PgnSink {
+public:
+    void game( const PgnGame& game ) override;
+
+    void error( const PgnError& error ) override;
+
+    std::size_t games  = 0;
+    std::size_t plies  = 0;
+    std::size_t errors = 0;
+};
+
+/**
+ * Writes each game as its file offset (uint64), its ply count (uint16) and then its packed moves (uint16 each), all in
+ * host byte order
+ *
+ * @throws std::system_error from any call if the file can't be written
+ */
+class PgnArchiveWriter : public PgnSink {
+public:
+    explicit PgnArchiveWriter( const std::string& path );
+
+    void game( const PgnGame& game ) override;
+
+    void finish() override;
+
+private:
+    void check();
+
+    std::string   path;
+    std::ofstream out;
+};
+
+class PgnCallback : public PgnSink {
+public:
+    using GameCallback = std::function<void( const PgnGame& )>;
+    using ErrorCallback = std::function<void( const PgnError& )>;
+
+    explicit PgnCallback( GameCallback onGame, ErrorCallback onError = {} ) :
+            onGame{ std::move( onGame ) }, onError{ std::move( onError ) } {}
+
+    void game( const PgnGame& game ) override { onGame( game ); }
+
+    void error( const PgnError& error ) override { if ( onError ) onError( error ); }
+
+private:
+    GameCallback  onGame;
+    ErrorCallback onError;
+};
+
+/**
+ * Replays every game of a PGN file through Chess. The file is memory mapped and cut into fixed size chunks that the
+ * worker threads claim one at a time; a worker handles the games that start inside its chunk, so memory use depends
+ * on the number of threads and not on the size of the file.
+ *
+ * Games are told apart by their tag sections, so text before the first one is replayed as a game without tags.
+ * Variations, comments and NAGs are skipped.
+ */
+class PgnImporter {
+public:
+    /**
+     * @throws std::system_error if the file can't be opened or mapped
+     */
+    explicit PgnImporter( const std::string& path );
+
+    PgnImporter( const PgnImporter& ) = delete;
+
+    ~PgnImporter();
+
+    /**
+     * @param threads number of worker threads, 0 to use one per hardware thread
+     */
+    PgnImportStats run( PgnSink& sink, unsigned threads = 0, std::size_t chunkSize = 1 << 20 );
+
+private:
+    [[nodiscard]] bool isGameStart( std::size_t position ) const;
+
+    [[nodiscard]] std::size_t nextGameStart( std::size_t position ) const;
+
+    const char* data = nullptr;
+    std::size_t size = 0;
+};
@@ -0,0 +1,67 @@
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "PgnImport.hpp"
+
+namespace {
+    int usage( const char* name ) {
+        std::cerr << "Usage: " << name << " <file.pgn> [--threads N] [--archive FILE] [--quiet]\n";
+        return EXIT_FAILURE;
+    }
+}
+
+int main( int argc, char** argv ) {
+    if ( argc < 2 ) return usage( argv[ 0 ] );
+
+    std::string path = argv[ 1 ];
+    std::string archive;
+    unsigned    threads = 0;
+    bool        quiet   = false;
+    for ( int i = 2; i < argc; ++i ) {
+        std::string arg = argv[ i ];
+        if ( arg == "--threads" && i + 1 < argc )
+            threads = static_cast<unsigned>(std::stoul( argv[ ++i ] ));
+        else if ( arg == "--archive" && i + 1 < argc )
+            archive = argv[ ++i ];
+        else if ( arg == "--quiet" )
+            quiet = true;
+        else
+            return usage( argv[ 0 ] );
+    }
+
+    try {
+        std::unique_ptr<PgnSink> sink;
+        if ( archive.empty())
+            sink = std::make_unique<PgnCounter>();
+        else
+            sink = std::make_unique<PgnArchiveWriter>( archive );
+
+        // report errors as they come, then hand games on to the chosen sink
+        PgnCallback reporter{
+                [ & ]( const PgnGame& game ) { sink->game( game ); },
+                [ & ]( const PgnError& error ) {
+                    if ( quiet ) return;
+                    std::cerr << path << ':' << error.offset << ": " << toString( error.kind );
+                    if ( error.token.empty())
+                        std::cerr << ", no result";
+                    else
+                        std::cerr << " '" << error.token << '\'';
+                    std::cerr << " at ply " << error.ply << " of the game at offset " << error.gameOffset << '\n';
+                }
+        };
+
+        PgnImporter importer{ path };
+        auto        stats = importer.run( reporter, threads );
+        // the reporter doesn't know about the sink it feeds, so the archive is flushed here
+        sink->finish();
+        std::cout << stats.games << " games, " << stats.plies << " plies, " << stats.errors << " rejected, "
+                  << stats.bytes / ( 1024.0 * 1024.0 ) << " MiB in " << stats.seconds << " s ("
+                  << stats.gamesPerSecond() << " games/s)\n";
+        return stats.errors == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    catch ( const std::exception& e ) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "Chess.hpp"
+#include "GameTree.hpp"
+
+// Checks that Chess::undo is the exact inverse of Chess::move, and that GameTree navigation lands on the same
+// positions as playing the moves from the start
+
+namespace {
+    struct Snapshot {
+        std::uint64_t            hash;
+        std::vector<std::string> board;
+        std::vector<std::string> moves;
+        bool                     whiteTurn;
+        bool                     inCheck;
+    };
+
+    Snapshot snapshot( const Chess& chess ) {
+        Snapshot result{ chess.hash(), {}, {}, chess.isWhiteTurn(), chess.isInCheck() };
+        for ( const auto& row: chess.boardState()) {
+            for ( const auto& cell: row ) {
+                result.board.push_back( cell.state == Chess::State::EMPTY ? "" :
+                                        std::to_string( (int) cell.state ) + std::to_string( (int) cell.piece ));
+            }
+        }
+        for ( const auto& move: chess.legalMoves())
+            result.moves.push_back( std::to_string( Chess::packMove( move )));
+        std::sort( result.moves.begin(), result.moves.end());
+        return result;
+    }
+
+    bool operator==( const Snapshot& a, const Snapshot& b ) {
+        return a.hash == b.hash && a.board == b.board && a.moves == b.moves &&
+               a.whiteTurn == b.whiteTurn && a.inCheck == b.inCheck;
+    }
+
+    int failures = 0;
+
+    void fail( const std::string& what ) {
+        std::cerr << "FAILED: " << what << '\n';
+        ++failures;
+    }
+
+    /**
+     * Makes and takes back every move from the current position
+     * @return the moves that were legal
+     */
+    std::vector<Chess::Move> checkAllMoves( Chess& chess, const std::string& where ) {
+        std::vector<Chess::Move> legal;
+        auto                     before = snapshot( chess );
+        for ( const auto& move: chess.legalMoves()) {
+            Chess::Undo undo;
+            if ( !chess.move( move.start, move.end, true, &undo )) continue;
+            legal.push_back( move );
+            chess.undo( move, undo );
+            if ( !( snapshot( chess ) == before ))
+                fail( where + ": move " + std::to_string( Chess::packMove( move )) + " isn't undone exactly" );
+        }
+        return legal;
+    }
+
+    void randomGames( unsigned seed, int games, int plies ) {
+        std::mt19937 random{ seed };
+        for ( int game = 0; game < games; ++game ) {
+            Chess                      chess;
+            GameTree                   tree{ chess };
+            std::vector<std::uint64_t> hashes{ chess.hash() };
+            for ( int ply = 0; ply < plies; ++ply ) {
+                auto where = "game " + std::to_string( game ) + " ply " + std::to_string( ply );
+                auto legal = checkAllMoves( chess, where );
+                if ( legal.empty()) break;
+                auto move = legal[ random() % legal.size() ];
+                if ( !tree.move( move )) fail( where + ": tree rejected a legal move" );
+                hashes.push_back( chess.hash());
+            }
+
+            // jump around the line and compare against the positions seen while playing it
+            for ( int i = 0; i < 20; ++i ) {
+                auto ply = static_cast<int>(random() % hashes.size());
+                if ( !tree.jumpToPly( ply ) || chess.hash() != hashes[ ply ] )
+                    fail( "game " + std::to_string( game ) + ": jump to ply " + std::to_string( ply ));
+            }
+        }
+    }
+}
+
+int main() {
+    // positions that exercise castling, including castling out from under pieces next to the king
+    for ( const char* fen: {
+            "r3kbnr/pppppppp/8/8/8/8/PPPPPPPP/4K3 b kq - 0 1",
+            "r3k2r/pppppppp/8/8/8/8/PPPPPPPP/R3K2R w KQkq - 0 1",
+            "r3k2r/pppppppp/8/8/8/8/PPPPPPPP/R3K2R b KQkq - 0 1",
+            "4k3/1P6/8/8/8/8/6p1/4K3 w - - 0 1",
+    } ) {
+        Chess chess{ fen };
+        checkAllMoves( chess, fen );
+    }
+
+    // a copy has to carry the castling rights, or it generates different moves
+    {
+        Chess chess{ "r3k2r/pppppppp/8/8/8/8/PPPPPPPP/R3K3 w Qk - 0 1" };
+        Chess copy{ chess };
+        if ( !( snapshot( copy ) == snapshot( chess ))) fail( "copy differs from the original" );
+    }
+
+    // positions move generation can't handle are rejected up front
+    for ( const char* fen: {
+            "P6k/8/8/8/8/8/8/6K1 w - - 0 1",
+            "6k1/8/8/8/8/8/8/p5K1 b - - 0 1",
+            "6k1/8/8/8/8/8/8/6K1 w K - 0 1",
+            "r3k3/8/8/8/8/8/8/4K3 b k - 0 1",
+            "4k3/8/8/8/8/8/8/4K3 w X - 0 1",
+    } ) {
+        try {
+            Chess chess{ fen };
+            fail( std::string{ fen } + ": accepted" );
+        }
+        catch ( const std::invalid_argument& ) {}
+    }
+
+    randomGames( 1, 3, 30 );
+
+    if ( failures ) return EXIT_FAILURE;
+    std::cout << "ok\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "MateSolver.hpp"
+
+// Checks the df-pn solver against a plain full-width search over every move, which is too slow to use but simple
+// enough to trust
+
+namespace {
+    int failures = 0;
+
+    void fail( const std::string& what ) {
+        std::cerr << "FAILED: " << what << '\n';
+        ++failures;
+    }
+
+    bool defenderLost( Chess& chess, int moves );
+
+    /**
+     * @return whether the player to move can mate within the given number of moves
+     */
+    bool attackerMates( Chess& chess, int moves ) {
+        if ( moves == 0 ) return false;
+        for ( const auto& move: chess.legalMoves()) {
+            Chess::Undo undo;
+            if ( !chess.move( move.start, move.end, false, &undo )) continue;
+            bool mates = defenderLost( chess, moves - 1 );
+            chess.undo( move, undo );
+            if ( mates ) return true;
+        }
+        return false;
+    }
+
+    /**
+     * @return whether the player to move is mated now or whatever they play, with the opponent having the given
+     * number of moves left
+     */
+    bool defenderLost( Chess& chess, int moves ) {
+        bool anyMove = false;
+        for ( const auto& move: chess.legalMoves()) {
+            Chess::Undo undo;
+            if ( !chess.move( move.start, move.end, false, &undo )) continue;
+            anyMove = true;
+            bool mated = attackerMates( chess, moves );
+            chess.undo( move, undo );
+            if ( !mated ) return false;
+        }
+        return anyMove || chess.isInCheck();
+    }
+}
+
+int main() {
+    struct Puzzle {
+        const char* fen;
+        int         moves;
+    };
+
+    MateSolver solver;
+    for ( const auto& puzzle: {
+            Puzzle{ "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", 1 },
+            Puzzle{ "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", 2 },
+            Puzzle{ "6k1/5ppp/8/8/8/8/8/R5K1 b - - 0 1", 2 },
+            Puzzle{ "r5k1/5ppp/8/8/8/8/5PPP/6K1 b - - 0 1", 1 },
+            Puzzle{ "r5k1/5ppp/8/8/8/8/5PPP/6K1 w - - 0 1", 1 },
+            Puzzle{ "6rk/6pp/8/6N1/8/8/8/6K1 w - - 0 1", 1 },
+            Puzzle{ "6rk/6pp/8/6N1/8/8/8/6K1 w - - 0 1", 2 },
+            Puzzle{ "k7/8/2K5/8/8/8/8/7R w - - 0 1", 1 },
+            Puzzle{ "k7/8/2K5/8/8/8/8/7R w - - 0 1", 2 },
+            Puzzle{ "1k6/8/1K6/8/8/8/8/3Q4 w - - 0 1", 1 },
+            Puzzle{ "6k1/8/6K1/8/8/8/8/Q7 w - - 0 1", 1 },
+            Puzzle{ "6k1/8/6K1/8/8/8/8/Q7 w - - 0 1", 2 },
+            Puzzle{ "2kr4/ppp5/8/8/8/8/5PPP/3R2K1 w - - 0 1", 1 },
+            Puzzle{ "2kr4/ppp5/8/8/8/8/5PPP/3R2K1 w - - 0 1", 2 },
+            // stalemated, so there is nothing to mate with
+            Puzzle{ "k7/8/1QK5/8/8/8/8/8 b - - 0 1", 2 },
+            // mates in one next to queen moves that stalemate
+            Puzzle{ "k7/2Q5/1K6/8/8/8/8/8 w - - 0 1", 1 },
+            Puzzle{ "7k/8/6K1/8/8/8/8/5Q2 w - - 0 1", 1 },
+            Puzzle{ "4k3/8/4K3/8/8/8/8/R7 w - - 0 1", 1 },
+    } ) {
+        auto  where = std::string{ puzzle.fen } + " in " + std::to_string( puzzle.moves );
+        Chess chess{ puzzle.fen };
+        bool  mate   = attackerMates( chess, puzzle.moves );
+        auto  result = solver.solve( chess, puzzle.moves, std::chrono::seconds{ 60 } );
+
+        auto expected = mate ? MateSolver::Outcome::MATE : MateSolver::Outcome::NO_MATE;
+        if ( result.outcome != expected ) {
+            fail( where + ": solver says " + toString( result.outcome ) + ", full search says " +
+                  toString( expected ));
+            continue;
+        }
+
+        // the move the solver gives has to start a mate as well
+        if ( mate ) {
+            Chess::Undo undo;
+            if ( !result.move || !chess.move( result.move->start, result.move->end, false, &undo ) ||
+                 !defenderLost( chess, puzzle.moves - 1 ))
+                fail( where + ": solver's first move doesn't mate" );
+        }
+    }
+
+    if ( failures ) return EXIT_FAILURE;
+    std::cout << "ok\n";
+    return EXIT_SUCCESS;
+}
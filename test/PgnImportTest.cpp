@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <vector>
+#include "PgnImport.hpp"
+
+// Imports a small fixture with one game per case the importer has to handle, and checks that the games and errors
+// don't depend on how the file is cut into chunks or how many threads replay it
+
+namespace {
+    using Game = std::pair<std::size_t, std::size_t>;            // offset, plies
+    using Error = std::tuple<PgnError::Kind, std::size_t, int>; // kind, offset, ply
+
+    struct Imported {
+        std::vector<Game>  games;
+        std::vector<Error> errors;
+        PgnImportStats     stats;
+    };
+
+    int failures = 0;
+
+    void fail( const std::string& what ) {
+        std::cerr << "FAILED: " << what << '\n';
+        ++failures;
+    }
+
+    std::string describe( const Error& error ) {
+        return std::string{ toString( std::get<0>( error )) } + " at " + std::to_string( std::get<1>( error )) +
+               " ply " + std::to_string( std::get<2>( error ));
+    }
+
+    Imported import( PgnImporter& importer, unsigned threads, std::size_t chunkSize ) {
+        Imported    result;
+        PgnCallback sink{
+                [ & ]( const PgnGame& game ) { result.games.emplace_back( game.offset, game.moves.size()); },
+                [ & ]( const PgnError& error ) { result.errors.emplace_back( error.kind, error.offset, error.ply ); }
+        };
+        result.stats = importer.run( sink, threads, chunkSize );
+
+        // games arrive in whatever order the workers finish them
+        std::sort( result.games.begin(), result.games.end());
+        std::sort( result.errors.begin(), result.errors.end(),
+                   []( const Error& a, const Error& b ) { return std::get<1>( a ) < std::get<1>( b ); } );
+        return result;
+    }
+}
+
+int main( int argc, char* argv[] ) {
+    if ( argc != 2 ) {
+        std::cerr << "usage: " << argv[ 0 ] << " <fixture.pgn>\n";
+        return EXIT_FAILURE;
+    }
+
+    std::ifstream in{ argv[ 1 ], std::ios::binary };
+    std::string   text{ std::istreambuf_iterator<char>{ in }, {}};
+    if ( text.empty()) {
+        std::cerr << argv[ 1 ] << ": can't read the fixture\n";
+        return EXIT_FAILURE;
+    }
+    auto at = [ & ]( const std::string& marker ) {
+        auto offset = text.find( marker );
+        if ( offset == std::string::npos ) fail( "fixture has no " + marker );
+        return offset;
+    };
+    auto game = [ & ]( const std::string& event ) { return at( "[Event \"" + event + "\"]" ); };
+
+    const std::vector<Game>  expectedGames{
+            { 0,                                                 2 }, // moves before the first tag pair
+            { game( "clock comment wrapped onto its own line" ), 4 },
+            { game( "knight from b5" ),                          7 },
+            { game( "promotion" ),                               9 },
+    };
+    const std::vector<Error> expectedErrors{
+            { PgnError::Kind::SYNTAX,      at( ") e5" ),                1 },
+            { PgnError::Kind::SYNTAX,      game( "knight from b5" ),    2 }, // the cut off game runs into the next one
+            { PgnError::Kind::AMBIGUOUS,   at( "Nd4 *" ),               6 },
+            { PgnError::Kind::UNSUPPORTED, at( "exd6" ),                4 },
+            { PgnError::Kind::UNSUPPORTED, at( "gxh8=N" ),              8 },
+    };
+
+    PgnImporter importer{ argv[ 1 ] };
+    for ( unsigned threads: { 1u, 4u } ) {
+        for ( std::size_t chunkSize: { std::size_t{ 1 }, std::size_t{ 7 }, std::size_t{ 1 << 20 } } ) {
+            auto where    = std::to_string( threads ) + " threads, chunks of " + std::to_string( chunkSize );
+            auto imported = import( importer, threads, chunkSize );
+
+            if ( imported.games != expectedGames )
+                fail( where + ": imported " + std::to_string( imported.games.size()) + " games" );
+            if ( imported.errors != expectedErrors ) {
+                fail( where + ": errors differ" );
+                for ( const auto& error: imported.errors )
+                    std::cerr << "    " << describe( error ) << '\n';
+            }
+            if ( imported.stats.games != expectedGames.size() || imported.stats.errors != expectedErrors.size() ||
+                 imported.stats.plies != 22 || imported.stats.bytes != text.size())
+                fail( where + ": stats don't match the sink" );
+        }
+    }
+
+#ifdef __linux__
+    // an archive that can't be written has to fail the run instead of being silently cut short
+    try {
+        PgnArchiveWriter archive{ "/dev/full" };
+        importer.run( archive, 2 );
+        fail( "writing to a full disk succeeded" );
+    }
+    catch ( const std::system_error& ) {}
+#endif
+
+    if ( failures ) return EXIT_FAILURE;
+    std::cout << "ok\n";
+    return EXIT_SUCCESS;
+}